@@ -0,0 +1,92 @@
+import Lean.Data.Json
+import Project.midterm
+import Bench.util
+
+open Lean (Json toJson)
+open structural_datatypes (Tree append append' map mapAppend' fold len treeMap inord leaves trim size)
+
+-- Usage: lake exe bench [listSize] [treeSize] [seed]
+-- Times every List and Tree operation and prints one JSON document. Each
+-- operation runs twice: once on an input that is still shared with the
+-- benchmark, and once on a fresh copy that it owns outright. For each run we
+-- report the wall time in nanoseconds, the allocations, the cells the result
+-- needs, and an estimate of how many of those cells were reused in place
+-- instead of allocated. Reuse only happens on the lean_is_exclusive fast path,
+-- so it only shows up on the owned run.
+--
+-- The estimate is cells minus allocations, so it is a lower bound. The
+-- allocation count also includes closures, Prods and any temporary lists an
+-- operation builds, e.g. the reversed copy that foldTR makes of a shared list.
+-- Those hide reuse that did happen.
+
+structure Row where
+  op : String
+  shape : String
+  input : String
+  ns : Nat
+  allocs : Nat
+  cells : Nat
+
+def Row.json (r : Row) : Json :=
+  let reused := r.cells - min r.allocs r.cells
+  Json.mkObj [
+    ("op", toJson r.op),
+    ("shape", toJson r.shape),
+    ("input", toJson r.input),
+    ("ns", toJson r.ns),
+    ("allocs", toJson r.allocs),
+    ("cells", toJson r.cells),
+    ("reused", toJson reused),
+    ("reusePercent", if r.cells = 0 then Json.null else toJson (reused * 100 / r.cells))]
+
+-- Runs op on the shared input, then on a copy that only op holds
+def benchOp {α β : Type} (name shape : String) (copy : β → β) (op : β → α) (cells : Nat) (x : β) : IO (List Row) := do
+  let (_, ns, allocs) ← measure fun _ => op x
+  let (_, ns', allocs') ← measureOwned op (copy x)
+  return [⟨name, shape, "shared", ns, allocs, cells⟩, ⟨name, shape, "owned", ns', allocs', cells⟩]
+
+def copyList (l : structural_datatypes.List Nat) : structural_datatypes.List Nat :=
+  map (fun x => x) l
+
+def copyTree (t : Tree Nat) : Tree Nat :=
+  treeMap (fun x => x) t
+
+def benchLists (n : Nat) : IO (List Row) := do
+  let A := listUpto n
+  let B := listUpto n
+  let f := fun (x : Nat) => 3 * x + 1
+  let g := fun (x acc : Nat) => (x + acc) % 1000003
+  let mut rows := []
+  rows := rows ++ (← benchOp "append" "list" copyList (fun l => append l B) n A)
+  rows := rows ++ (← benchOp "append'" "list" copyList (fun l => append' l B) n A)
+  rows := rows ++ (← benchOp "map" "list" copyList (map f) n A)
+  rows := rows ++ (← benchOp "mapAppend'" "list" copyList (mapAppend' f B) n A)
+  rows := rows ++ (← benchOp "fold" "list" copyList (fold g 0) 0 A)
+  rows := rows ++ (← benchOp "len" "list" copyList len 0 A)
+  return rows
+
+def benchTree (shape : String) (T : Tree Nat) : IO (List Row) := do
+  let f := fun (x : Nat) => 3 * x + 1
+  let n := size T
+  let mut rows := []
+  rows := rows ++ (← benchOp "treeMap" shape copyTree (treeMap f) n T)
+  rows := rows ++ (← benchOp "inord" shape copyTree inord n T)
+  rows := rows ++ (← benchOp "leaves" shape copyTree leaves (len (leaves T)) T)
+  rows := rows ++ (← benchOp "trim" shape copyTree trim (size (trim T)) T)
+  rows := rows ++ (← benchOp "size" shape copyTree size 0 T)
+  return rows
+
+def main (args : List String) : IO Unit := do
+  let listSize := argNat args 0 1000000
+  let treeSize := argNat args 1 100000
+  let seed := argNat args 2 42
+  let mut rows := ← benchLists listSize
+  rows := rows ++ (← benchTree "balanced" (balancedTree treeSize))
+  rows := rows ++ (← benchTree "left-skewed" (leftSkewedTree treeSize))
+  rows := rows ++ (← benchTree "right-skewed" (rightSkewedTree treeSize))
+  rows := rows ++ (← benchTree "random" (randomTree treeSize seed))
+  IO.println (Json.mkObj [
+    ("listSize", toJson listSize),
+    ("treeSize", toJson treeSize),
+    ("seed", toJson seed),
+    ("results", Json.arr (rows.map Row.json).toArray)]).pretty
@@ -0,0 +1,40 @@
+import Project.parallel
+import Bench.util
+
+open structural_datatypes (Tree treeMap size treeMapPar sizePar)
+
+-- Usage: lake exe parbench [depth] [work] [maxCutoff]
+-- Times treeMapPar and sizePar at every cutoff from 1 up to maxCutoff, on a
+-- balanced tree of the given depth and on a left-skewed tree with the same
+-- number of nodes. The cutoff 0 row times plain treeMap and size instead, since
+-- treeMapPar 0 would still spawn one task and wait on it, and the baseline
+-- should not pay for that. Cutoff c runs on up to 2^c tasks, so the
+-- time should drop until 2^c reaches the number of cores; pin the process with
+-- `taskset -c 0-(k-1)` to see how it scales with k cores.
+
+-- Something expensive enough per element that the tasks have work to do
+def spin (work : Nat) (x : Nat) : Nat :=
+  Nat.fold (fun i acc => (acc * 31 + i) % 1000003) work x
+
+def checksum (t : Tree Nat) : Nat :=
+  match t with
+    | Tree.Empty => 0
+    | Tree.Node L x R => (checksum L + x + checksum R) % 1000003
+
+def runShape (shape : String) (t : Tree Nat) (work maxCutoff : Nat) : IO Unit := do
+  for c in List.range (maxCutoff + 1) do
+    if c = 0 then
+      let (m, tm, _) ← measure fun _ => checksum (treeMap (spin work) t)
+      let (s, ts, _) ← measure fun _ => size t
+      IO.println s!"{shape}\tcutoff=0\ttasks=0\ttreeMap={tm / 1000}us\tsize={ts / 1000}us\tchecksum={m}\tnodes={s}"
+    else
+      let (m, tm, _) ← measure fun _ => checksum (treeMapPar c (spin work) t)
+      let (s, ts, _) ← measure fun _ => sizePar c t
+      IO.println s!"{shape}\tcutoff={c}\ttasks<={2 ^ c}\ttreeMapPar={tm / 1000}us\tsizePar={ts / 1000}us\tchecksum={m}\tnodes={s}"
+
+def main (args : List String) : IO Unit := do
+  let depth := argNat args 0 16
+  let work := argNat args 1 200
+  let maxCutoff := argNat args 2 6
+  runShape "balanced" (balancedTree (2 ^ depth - 1)) work maxCutoff
+  runShape "left-skewed" (leftSkewedTree (2 ^ depth - 1)) work maxCutoff
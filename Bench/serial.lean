@@ -0,0 +1,84 @@
+import Project.serialize
+import Bench.util
+
+open structural_datatypes (Tree treeMap map encodeList encodeTree decodeList decodeTree writeList writeTree)
+
+-- Usage: lake exe serialbench [listSize] [treeSize] [seed]
+-- First checks decode (encode x) = x on a few hundred random Lists and Trees,
+-- both straight from a ByteArray and through a file written in small chunks,
+-- and exits with 1 if any of them fails. Then, for each input, prints how long
+-- it takes to rebuild it from scratch against how long it takes to encode it,
+-- to decode it from memory, and to read it back from a file and decode it.
+
+def listEq (A B : structural_datatypes.List UInt64) : Bool :=
+  match A, B with
+    | structural_datatypes.List.Nil, structural_datatypes.List.Nil => true
+    | structural_datatypes.List.Cons x xs, structural_datatypes.List.Cons y ys => x == y && listEq xs ys
+    | _, _ => false
+
+def treeEq (S T : Tree UInt64) : Bool :=
+  match S, T with
+    | Tree.Empty, Tree.Empty => true
+    | Tree.Node L x R, Tree.Node L' y R' => x == y && treeEq L L' && treeEq R R'
+    | _, _ => false
+
+def toU64List (l : structural_datatypes.List Nat) : structural_datatypes.List UInt64 :=
+  map Nat.toUInt64 l
+
+def toU64Tree (t : Tree Nat) : Tree UInt64 :=
+  treeMap Nat.toUInt64 t
+
+def path : System.FilePath := "serialbench.tmp"
+
+def viaFile {α : Type} (write : IO.FS.Handle → IO Unit) (decode : ByteArray → Option α) : IO (Option α) := do
+  IO.FS.withFile path IO.FS.Mode.write write
+  let bytes ← IO.FS.readBinFile path
+  IO.FS.removeFile path
+  return decode bytes
+
+-- Big payloads too, so every byte of the UInt64s gets exercised
+def randomList (n : Nat) (seed : Nat) : structural_datatypes.List UInt64 :=
+  match n with
+    | 0 => structural_datatypes.List.Nil
+    | k+1 => structural_datatypes.List.Cons (nextSeed seed).toUInt64 (randomList k (nextSeed seed))
+
+def checkRoundTrips (count : Nat) : IO Bool := do
+  let mut ok := true
+  for seed in [0:count] do
+    let l := randomList (seed % 50) seed
+    let t := toU64Tree (randomTree (seed % 64) seed)
+    -- Chunk sizes 0 to 8, so flushes land everywhere, including after every byte
+    let chunk := seed % 9
+    let listOk := (decodeList (encodeList l)).any (listEq l)
+    let treeOk := (decodeTree (encodeTree t)).any (treeEq t)
+    let listFileOk := (← viaFile (fun h => writeList h l chunk) decodeList).any (listEq l)
+    let treeFileOk := (← viaFile (fun h => writeTree h t chunk) decodeTree).any (treeEq t)
+    if !(listOk && treeOk && listFileOk && treeFileOk) then
+      IO.eprintln s!"round trip failed for seed {seed}: list {listOk}/{listFileOk}, tree {treeOk}/{treeFileOk}"
+      ok := false
+  return ok
+
+def report {α : Type} (name : String) (rebuild : Unit → α) (encode : α → ByteArray) (decode : ByteArray → Option α)
+    (write : α → IO.FS.Handle → IO Unit) (eq : α → α → Bool) : IO Unit := do
+  let (x, tRebuild, aRebuild) ← measure rebuild
+  let (bytes, tEncode, _) ← measure fun _ => encode x
+  let (y, tDecode, aDecode) ← measure fun _ => decode bytes
+  let t0 ← IO.monoNanosNow
+  let z ← viaFile (write x) decode
+  let t1 ← IO.monoNanosNow
+  let same := y.any (eq x) && z.any (eq x)
+  IO.println s!"{name}\t{bytes.size} bytes\trebuild: {tRebuild / 1000}us {aRebuild} allocs\tencode: {tEncode / 1000}us\tdecode: {tDecode / 1000}us {aDecode} allocs\tfile round trip: {(t1 - t0) / 1000}us\tsame result: {same}"
+
+def main (args : List String) : IO UInt32 := do
+  let listSize := argNat args 0 1000000
+  let treeSize := argNat args 1 100000
+  let seed := argNat args 2 42
+  if !(← checkRoundTrips 300) then
+    return 1
+  IO.println "round trips: ok"
+  report "list" (fun _ => toU64List (listUpto listSize)) encodeList decodeList (fun l h => writeList h l) listEq
+  report "balanced" (fun _ => toU64Tree (balancedTree treeSize)) encodeTree decodeTree (fun t h => writeTree h t) treeEq
+  report "left-skewed" (fun _ => toU64Tree (leftSkewedTree treeSize)) encodeTree decodeTree (fun t h => writeTree h t) treeEq
+  report "right-skewed" (fun _ => toU64Tree (rightSkewedTree treeSize)) encodeTree decodeTree (fun t h => writeTree h t) treeEq
+  report "random" (fun _ => toU64Tree (randomTree treeSize seed)) encodeTree decodeTree (fun t h => writeTree h t) treeEq
+  return 0
@@ -0,0 +1,81 @@
+import Project.midterm
+
+open structural_datatypes (Tree)
+
+-- Shared helpers for the benchmark executables
+
+-- Runs f x once and returns its result, the wall time in nanoseconds and the
+-- number of small-object allocations made on this thread. The runtime counts
+-- every small allocation as a heartbeat. That covers the cons cells and tree
+-- nodes of the result, but also closures, Prods, Tasks, bignums and any
+-- temporary lists f builds along the way. x is passed on owned, so if the
+-- caller gives up its last reference, f gets to update it in place.
+@[noinline] def measureOwned {α β : Type} (f : β → α) (x : β) : IO (α × Nat × Nat) := do
+  let h0 ← IO.getNumHeartbeats
+  let t0 ← IO.monoNanosNow
+  let a ← pure (f x)
+  let t1 ← IO.monoNanosNow
+  let h1 ← IO.getNumHeartbeats
+  return (a, t1 - t0, h1 - h0)
+
+def measure {α : Type} (act : Unit → α) : IO (α × Nat × Nat) :=
+  measureOwned act ()
+
+def argNat (args : List String) (i : Nat) (default : Nat) : Nat :=
+  (args.get? i >>= String.toNat?).getD default
+
+-- Inputs
+
+-- [0, 1, ..., n-1], built with a loop
+def listUptoAux (n : Nat) (acc : structural_datatypes.List Nat) : structural_datatypes.List Nat :=
+  match n with
+    | 0 => acc
+    | k+1 => listUptoAux k (structural_datatypes.List.Cons k acc)
+
+def listUpto (n : Nat) : structural_datatypes.List Nat :=
+  listUptoAux n structural_datatypes.List.Nil
+
+-- A tree with n nodes labelled lo, lo+1, ... in order, as balanced as it gets.
+-- fuel only has to outlast the depth, and n itself always does.
+def balancedAux (fuel : Nat) (lo : Nat) (n : Nat) : Tree Nat :=
+  match fuel with
+    | 0 => Tree.Empty
+    | fuel+1 =>
+        if n = 0 then Tree.Empty
+        else Tree.Node (balancedAux fuel lo (n / 2)) (lo + n / 2) (balancedAux fuel (lo + n / 2 + 1) (n - 1 - n / 2))
+
+def balancedTree (n : Nat) : Tree Nat :=
+  balancedAux n 0 n
+
+def leftSkewedAux (i : Nat) (n : Nat) (t : Tree Nat) : Tree Nat :=
+  match n with
+    | 0 => t
+    | k+1 => leftSkewedAux (i + 1) k (Tree.Node t i Tree.Empty)
+
+def leftSkewedTree (n : Nat) : Tree Nat :=
+  leftSkewedAux 0 n Tree.Empty
+
+def rightSkewedAux (i : Nat) (n : Nat) (t : Tree Nat) : Tree Nat :=
+  match n with
+    | 0 => t
+    | k+1 => rightSkewedAux (i + 1) k (Tree.Node Tree.Empty i t)
+
+def rightSkewedTree (n : Nat) : Tree Nat :=
+  rightSkewedAux 0 n Tree.Empty
+
+def nextSeed (seed : Nat) : Nat :=
+  (seed * 6364136223846793005 + 1442695040888963407) % 18446744073709551616
+
+def bstInsert (x : Nat) (t : Tree Nat) : Tree Nat :=
+  match t with
+    | Tree.Empty => Tree.Node Tree.Empty x Tree.Empty
+    | Tree.Node L y R => if x < y then Tree.Node (bstInsert x L) y R else Tree.Node L y (bstInsert x R)
+
+def randomTreeAux (n : Nat) (seed : Nat) (t : Tree Nat) : Tree Nat :=
+  match n with
+    | 0 => t
+    | k+1 => randomTreeAux k (nextSeed seed) (bstInsert (nextSeed seed / 65536) t)
+
+-- n random keys inserted into a binary search tree
+def randomTree (n : Nat) (seed : Nat) : Tree Nat :=
+  randomTreeAux n seed Tree.Empty
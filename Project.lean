@@ -1,3 +1,9 @@
 -- This module serves as the root of the `Project` library.
 -- Import modules here that should be built as part of the library.
-import «Project».Basic
\ No newline at end of file
+import «Project».midterm
+import «Project».sizedTree
+import «Project».parallel
+import «Project».chunkedList
+import «Project».rope
+import «Project».fusion
+import «Project».serialize
@@ -0,0 +1,179 @@
+import Std.Data.Array.Lemmas
+import Project.midterm
+
+namespace structural_datatypes
+
+-- Every Cons is its own allocation, so walking a long List is mostly cache
+-- misses. A ChunkedList keeps the elements in Arrays, one block per node, and
+-- the operations below work a whole block at a time.
+
+inductive ChunkedList (α : Type) where
+  | Nil : ChunkedList α
+  | Chunk : Array α → ChunkedList α → ChunkedList α
+
+def chunkedToList {α : Type} (c : ChunkedList α) : List α :=
+  match c with
+    | ChunkedList.Nil => List.Nil
+    | ChunkedList.Chunk a rest => (ofStdList a.data) @ (chunkedToList rest)
+
+-- a.data builds one of Lean's lists and ofStdList copies it into ours, so the
+-- compiled version conses straight out of the Array instead
+
+def chunkedToListTR {α : Type} (c : ChunkedList α) : List α :=
+  match c with
+    | ChunkedList.Nil => List.Nil
+    | ChunkedList.Chunk a rest => a.foldr (fun x acc ↦ x::acc) (chunkedToListTR rest)
+
+theorem chunkedToListTREquiv {α : Type} (c : ChunkedList α) : chunkedToListTR c = chunkedToList c := by
+  induction c with
+  | Nil => rfl
+  | Chunk a rest ih =>
+      calc
+        chunkedToListTR (ChunkedList.Chunk a rest) = a.foldr (fun x acc ↦ x::acc) (chunkedToListTR rest) := by rfl
+        _                 = a.data.foldr (fun x acc ↦ x::acc) (chunkedToList rest) := by rw [Array.foldr_eq_foldr_data, ih]
+        _                 = fold (fun x acc ↦ x::acc) (chunkedToList rest) (ofStdList a.data) := by rw [foldrOfStdList]
+        _                 = (ofStdList a.data) @ (chunkedToList rest) := by rw [foldAppendEquiv, append']
+        _                 = chunkedToList (ChunkedList.Chunk a rest) := by rfl
+
+@[csimp] theorem chunkedToListEqChunkedToListTR : @chunkedToList = @chunkedToListTR := by
+  apply funext; intro α
+  apply funext; intro c
+  exact (chunkedToListTREquiv c).symm
+
+-- Building one: fill a block of up to n elements, then start the next one
+
+def chunkedOfListAux {α : Type} (n : Nat) (buf : Array α) (l : List α) : ChunkedList α :=
+  match l with
+    | List.Nil => if buf.size = 0 then ChunkedList.Nil else ChunkedList.Chunk buf ChunkedList.Nil
+    | List.Cons x xs =>
+        if n ≤ buf.size + 1 then ChunkedList.Chunk (buf.push x) (chunkedOfListAux n (Array.mkEmpty n) xs)
+        else chunkedOfListAux n (buf.push x) xs
+
+def chunkedOfList {α : Type} (n : Nat) (l : List α) : ChunkedList α :=
+  chunkedOfListAux n (Array.mkEmpty n) l
+
+theorem chunkedToListOfListAux {α : Type} (n : Nat) (buf : Array α) (l : List α) :
+  chunkedToList (chunkedOfListAux n buf l) = (ofStdList buf.data) @ l := by
+  induction l generalizing buf with
+  | Nil =>
+      show chunkedToList (if buf.size = 0 then ChunkedList.Nil else ChunkedList.Chunk buf ChunkedList.Nil) = (ofStdList buf.data) @ List.Nil
+      split
+      next h =>
+          cases buf with
+          | mk data =>
+              cases data with
+              | nil => rfl
+              | cons a as => exact absurd h (Nat.succ_ne_zero as.length)
+      next _ => rfl
+  | Cons x xs ih =>
+      show chunkedToList (if n ≤ buf.size + 1 then ChunkedList.Chunk (buf.push x) (chunkedOfListAux n (Array.mkEmpty n) xs)
+                          else chunkedOfListAux n (buf.push x) xs) = (ofStdList buf.data) @ (x::xs)
+      split
+      next _ =>
+          calc
+            chunkedToList (ChunkedList.Chunk (buf.push x) (chunkedOfListAux n (Array.mkEmpty n) xs)) =
+                        (ofStdList (buf.data.concat x)) @ (chunkedToList (chunkedOfListAux n (Array.mkEmpty n) xs)) := by rfl
+            _         = (ofStdList (buf.data.concat x)) @ ((ofStdList (Array.mkEmpty n : Array α).data) @ xs) := by rw [ih]
+            _         = (ofStdList (buf.data.concat x)) @ xs := by rfl
+            _         = ((ofStdList buf.data) @ (x::List.Nil)) @ xs := by rw [ofStdListConcat]
+            _         = (ofStdList buf.data) @ ((x::List.Nil) @ xs) := by rw [appendAssoc]
+            _         = (ofStdList buf.data) @ (x::xs) := by rfl
+      next _ =>
+          calc
+            chunkedToList (chunkedOfListAux n (buf.push x) xs) = (ofStdList (buf.push x).data) @ xs := by rw [ih]
+            _         = (ofStdList (buf.data.concat x)) @ xs := by rfl
+            _         = ((ofStdList buf.data) @ (x::List.Nil)) @ xs := by rw [ofStdListConcat]
+            _         = (ofStdList buf.data) @ ((x::List.Nil) @ xs) := by rw [appendAssoc]
+            _         = (ofStdList buf.data) @ (x::xs) := by rfl
+
+theorem chunkedToListOfList {α : Type} (n : Nat) (l : List α) : chunkedToList (chunkedOfList n l) = l := by
+  calc
+    chunkedToList (chunkedOfList n l) = (ofStdList (Array.mkEmpty n : Array α).data) @ l := chunkedToListOfListAux n (Array.mkEmpty n) l
+    _                                 = l := by rfl
+
+-- The operations, each of which commutes with chunkedToList
+
+def chunkedAppend {α : Type} (c : ChunkedList α) (d : ChunkedList α) : ChunkedList α :=
+  match c with
+    | ChunkedList.Nil => d
+    | ChunkedList.Chunk a rest => ChunkedList.Chunk a (chunkedAppend rest d)
+
+def chunkedMap {α β : Type} (f : α → β) (c : ChunkedList α) : ChunkedList β :=
+  match c with
+    | ChunkedList.Nil => ChunkedList.Nil
+    | ChunkedList.Chunk a rest => ChunkedList.Chunk (a.map f) (chunkedMap f rest)
+
+def chunkedFold {α β : Type} (g : α → β → β) (z : β) (c : ChunkedList α) : β :=
+  match c with
+    | ChunkedList.Nil => z
+    | ChunkedList.Chunk a rest => a.foldr g (chunkedFold g z rest)
+
+def chunkedLen {α : Type} (c : ChunkedList α) : Nat :=
+  match c with
+    | ChunkedList.Nil => 0
+    | ChunkedList.Chunk a rest => a.size + chunkedLen rest
+
+theorem chunkedAppendEquiv {α : Type} (c : ChunkedList α) (d : ChunkedList α) :
+  chunkedToList (chunkedAppend c d) = (chunkedToList c) @ (chunkedToList d) := by
+  induction c with
+  | Nil =>
+      calc
+        chunkedToList (chunkedAppend ChunkedList.Nil d) = chunkedToList d := by rfl
+        _                                               = List.Nil @ (chunkedToList d) := by rw [append]
+        _                                               = (chunkedToList ChunkedList.Nil) @ (chunkedToList d) := by rfl
+  | Chunk a rest ih =>
+      calc
+        chunkedToList (chunkedAppend (ChunkedList.Chunk a rest) d) = (ofStdList a.data) @ (chunkedToList (chunkedAppend rest d)) := by rfl
+        _                 = (ofStdList a.data) @ ((chunkedToList rest) @ (chunkedToList d)) := by rw [ih]
+        _                 = ((ofStdList a.data) @ (chunkedToList rest)) @ (chunkedToList d) := by rw [appendAssoc]
+        _                 = (chunkedToList (ChunkedList.Chunk a rest)) @ (chunkedToList d) := by rfl
+
+theorem chunkedMapEquiv {α β : Type} (f : α → β) (c : ChunkedList α) :
+  chunkedToList (chunkedMap f c) = map f (chunkedToList c) := by
+  induction c with
+  | Nil => rfl
+  | Chunk a rest ih =>
+      calc
+        chunkedToList (chunkedMap f (ChunkedList.Chunk a rest)) = (ofStdList (a.map f).data) @ (chunkedToList (chunkedMap f rest)) := by rfl
+        _                 = (ofStdList (a.data.map f)) @ (map f (chunkedToList rest)) := by rw [Array.map_data, ih]
+        _                 = (map f (ofStdList a.data)) @ (map f (chunkedToList rest)) := by rw [ofStdListMap]
+        _                 = map f ((ofStdList a.data) @ (chunkedToList rest)) := by rw [mapAppend]
+        _                 = map f (chunkedToList (ChunkedList.Chunk a rest)) := by rfl
+
+theorem chunkedFoldEquiv {α β : Type} (g : α → β → β) (z : β) (c : ChunkedList α) :
+  chunkedFold g z c = fold g z (chunkedToList c) := by
+  induction c with
+  | Nil => rfl
+  | Chunk a rest ih =>
+      calc
+        chunkedFold g z (ChunkedList.Chunk a rest) = a.foldr g (chunkedFold g z rest) := by rfl
+        _                 = a.data.foldr g (fold g z (chunkedToList rest)) := by rw [Array.foldr_eq_foldr_data, ih]
+        _                 = fold g (fold g z (chunkedToList rest)) (ofStdList a.data) := by rw [foldrOfStdList]
+        _                 = fold g z ((ofStdList a.data) @ (chunkedToList rest)) := by rw [foldAppend]
+        _                 = fold g z (chunkedToList (ChunkedList.Chunk a rest)) := by rfl
+
+theorem chunkedLenEquiv {α : Type} (c : ChunkedList α) : chunkedLen c = len (chunkedToList c) := by
+  induction c with
+  | Nil => rfl
+  | Chunk a rest ih =>
+      calc
+        chunkedLen (ChunkedList.Chunk a rest) = a.data.length + chunkedLen rest := by rfl
+        _                 = len (ofStdList a.data) + len (chunkedToList rest) := by rw [lenOfStdList, ih]
+        _                 = len ((ofStdList a.data) @ (chunkedToList rest)) := by rw [lenAppend]
+        _                 = len (chunkedToList (ChunkedList.Chunk a rest)) := by rfl
+
+-- So the append theorems for List carry straight over
+
+theorem chunkedMapAppend {α β : Type} (c : ChunkedList α) (d : ChunkedList α) (f : α → β) :
+  chunkedToList (chunkedMap f (chunkedAppend c d)) = (chunkedToList (chunkedMap f c)) @ (chunkedToList (chunkedMap f d)) := by
+  simp only [chunkedMapEquiv, chunkedAppendEquiv, mapAppend]
+
+theorem chunkedLenAppend {α : Type} (c : ChunkedList α) (d : ChunkedList α) :
+  chunkedLen (chunkedAppend c d) = chunkedLen c + chunkedLen d := by
+  simp only [chunkedLenEquiv, chunkedAppendEquiv, lenAppend]
+
+theorem chunkedFoldAppend {α β : Type} (c : ChunkedList α) (d : ChunkedList α) (g : α → β → β) (z : β) :
+  chunkedFold g z (chunkedAppend c d) = chunkedFold g (chunkedFold g z d) c := by
+  simp only [chunkedFoldEquiv, chunkedAppendEquiv, foldAppend]
+
+end structural_datatypes
@@ -0,0 +1,93 @@
+import Project.midterm
+
+namespace structural_datatypes
+
+-- fold g z (map f (A @ B)) builds A @ B, then maps it into a second list, and
+-- only then folds. foldMap applies f as it folds, so no cons cells are built
+-- in between. The rewrites below turn a map/append/fold pipeline into nested
+-- foldMaps, and the `fuse` tactic applies all of them.
+
+def foldMap {α β γ : Type} (g : β → γ → γ) (z : γ) (f : α → β) (l : List α) : γ :=
+  match l with
+  | List.Nil => z
+  | List.Cons x xs => g (f x) (foldMap g z f xs)
+
+theorem foldMapEquiv {α β γ : Type} (g : β → γ → γ) (z : γ) (f : α → β) (l : List α) :
+  foldMap g z f l = fold (fun x acc ↦ g (f x) acc) z l := by
+  induction l with
+  | Nil => rfl
+  | Cons x xs ih =>
+      calc
+        foldMap g z f (x::xs) = g (f x) (foldMap g z f xs) := by rfl
+        _                     = g (f x) (fold (fun x acc ↦ g (f x) acc) z xs) := by rw [ih]
+        _                     = fold (fun x acc ↦ g (f x) acc) z (x::xs) := by rfl
+
+-- Compiled through foldTR like fold itself, so it stays stack-safe and builds
+-- one Array rather than any cons cells
+def foldMapTR {α β γ : Type} (g : β → γ → γ) (z : γ) (f : α → β) (l : List α) : γ :=
+  foldTR (fun x acc ↦ g (f x) acc) z l
+
+theorem foldMapTREquiv {α β γ : Type} (g : β → γ → γ) (z : γ) (f : α → β) (l : List α) :
+  foldMapTR g z f l = foldMap g z f l := by
+  rw [foldMapTR, foldTREquiv, foldMapEquiv]
+
+@[csimp] theorem foldMapEqFoldMapTR : @foldMap = @foldMapTR := by
+  apply funext; intro α
+  apply funext; intro β
+  apply funext; intro γ
+  apply funext; intro g
+  apply funext; intro z
+  apply funext; intro f
+  apply funext; intro l
+  exact (foldMapTREquiv g z f l).symm
+
+-- The fusion rules
+
+theorem foldMapFusion {α β γ : Type} (g : β → γ → γ) (z : γ) (f : α → β) (l : List α) :
+  fold g z (map f l) = foldMap g z f l := by
+  induction l with
+  | Nil => rfl
+  | Cons x xs ih =>
+      calc
+        fold g z (map f (x::xs)) = g (f x) (fold g z (map f xs)) := by rfl
+        _                        = g (f x) (foldMap g z f xs) := by rw [ih]
+        _                        = foldMap g z f (x::xs) := by rfl
+
+theorem foldMapAppendFusion {α β γ : Type} (g : β → γ → γ) (z : γ) (f : α → β) (A B : List α) :
+  foldMap g z f (A @ B) = foldMap g (foldMap g z f B) f A := by
+  calc
+    foldMap g z f (A @ B) = fold g z (map f (A @ B)) := by rw [foldMapFusion]
+    _                     = fold g z ((map f A) @ (map f B)) := by rw [mapAppend]
+    _                     = fold g (fold g z (map f B)) (map f A) := by rw [foldAppend]
+    _                     = foldMap g (foldMap g z f B) f A := by rw [foldMapFusion, foldMapFusion]
+
+theorem foldMapMapFusion {α β γ δ : Type} (g : γ → δ → δ) (z : δ) (f : β → γ) (h : α → β) (l : List α) :
+  foldMap g z f (map h l) = foldMap g z (fun x ↦ f (h x)) l := by
+  induction l with
+  | Nil => rfl
+  | Cons x xs ih =>
+      calc
+        foldMap g z f (map h (x::xs)) = g (f (h x)) (foldMap g z f (map h xs)) := by rfl
+        _                             = g (f (h x)) (foldMap g z (fun x ↦ f (h x)) xs) := by rw [ih]
+        _                             = foldMap g z (fun x ↦ f (h x)) (x::xs) := by rfl
+
+theorem mapMapFusion {α β γ : Type} (f : β → γ) (h : α → β) (l : List α) :
+  map f (map h l) = map (fun x ↦ f (h x)) l := by
+  induction l with
+  | Nil => rfl
+  | Cons x xs ih =>
+      calc
+        map f (map h (x::xs)) = (f (h x))::(map f (map h xs)) := by rfl
+        _                     = (f (h x))::(map (fun x ↦ f (h x)) xs) := by rw [ih]
+        _                     = map (fun x ↦ f (h x)) (x::xs) := by rfl
+
+-- fuse rewrites a goal's pipelines into their fused forms, e.g.
+-- fold g z (map f (A @ B)) becomes foldMap g (foldMap g z f B) f A
+macro "fuse" : tactic =>
+  `(tactic| simp only [foldMapFusion, foldMapAppendFusion, foldMapMapFusion, mapMapFusion, foldAppend])
+
+theorem foldMapAppendPipeline {α β γ : Type} (g : β → γ → γ) (z : γ) (f : α → β) (A B : List α) :
+  fold g z (map f (A @ B)) = foldMap g (foldMap g z f B) f A := by
+  fuse
+
+end structural_datatypes
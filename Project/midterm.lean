@@ -1,3 +1,5 @@
+import Std.Data.Array.Lemmas
+
 namespace structural_datatypes
 
 inductive List (α : Type) where
@@ -147,7 +149,227 @@ theorem mapAppend'' {α β : Type} (A : List α) (B : List α) (f : α → β) :
     _             = (map f A) @ (map f B) := by rw [appendNil]
 
 
+-- Arrays hand us Lean's built-in lists, so we need a way to turn those into ours
+def ofStdList {α : Type} (l : _root_.List α) : List α :=
+  match l with
+    | _root_.List.nil => List.Nil
+    | _root_.List.cons x xs => x::(ofStdList xs)
+
+theorem ofStdListConcat {α : Type} (l : _root_.List α) (x : α) :
+  ofStdList (l.concat x) = (ofStdList l) @ (x::List.Nil) := by
+  induction l with
+  | nil => rfl
+  | cons a as ih =>
+      calc
+        ofStdList ((_root_.List.cons a as).concat x) = a::(ofStdList (as.concat x)) := by rfl
+        _                                            = a::((ofStdList as) @ (x::List.Nil)) := by rw [ih]
+        _                                            = (a::(ofStdList as)) @ (x::List.Nil) := by rw [append]
+        _                                            = (ofStdList (_root_.List.cons a as)) @ (x::List.Nil) := by rfl
+
+theorem lenOfStdList {α : Type} (l : _root_.List α) : len (ofStdList l) = l.length := by
+  induction l with
+  | nil => rfl
+  | cons a as ih =>
+      calc
+        len (ofStdList (_root_.List.cons a as)) = 1 + len (ofStdList as) := by rfl
+        _                                       = 1 + as.length := by rw [ih]
+        _                                       = as.length + 1 := by rw [Nat.add_comm]
+        _                                       = (_root_.List.cons a as).length := by rfl
+
+theorem ofStdListMap {α β : Type} (f : α → β) (l : _root_.List α) : ofStdList (l.map f) = map f (ofStdList l) := by
+  induction l with
+  | nil => rfl
+  | cons a as ih =>
+      calc
+        ofStdList ((_root_.List.cons a as).map f) = (f a)::(ofStdList (as.map f)) := by rfl
+        _                                         = (f a)::(map f (ofStdList as)) := by rw [ih]
+        _                                         = map f (ofStdList (_root_.List.cons a as)) := by rfl
+
+theorem foldrOfStdList {α β : Type} (g : α → β → β) (z : β) (l : _root_.List α) : l.foldr g z = fold g z (ofStdList l) := by
+  induction l with
+  | nil => rfl
+  | cons a as ih =>
+      calc
+        (_root_.List.cons a as).foldr g z = g a (as.foldr g z) := by rfl
+        _                                 = g a (fold g z (ofStdList as)) := by rw [ih]
+        _                                 = fold g z (ofStdList (_root_.List.cons a as)) := by rfl
+
+
+-- The definitions above are what we reason about, but they all recurse before
+-- doing their work, so the compiled code needs one stack frame per cell. Below
+-- are loop versions of each, proven equal to the originals and registered with
+-- @[csimp] so the compiler swaps them in while the proofs keep the simple ones.
+
+theorem appendNil {α : Type} (l : List α) : l @ List.Nil = l := by
+  induction l with
+  | Nil => rw [append]
+  | Cons x xs ih =>
+      calc
+        (x::xs) @ List.Nil = x::(xs @ List.Nil) := by rw [append]
+        _                  = x::xs := by rw [ih]
+
+theorem appendAssoc {α : Type} (A B C : List α) : (A @ B) @ C = A @ (B @ C) := by
+  induction A with
+  | Nil =>
+      calc
+        (List.Nil @ B) @ C = B @ C := by rw [append]
+        _                  = List.Nil @ (B @ C) := by rw [append]
+  | Cons x xs ih =>
+      calc
+        ((x::xs) @ B) @ C = (x::(xs @ B)) @ C := by rw [append]
+        _                 = x::((xs @ B) @ C) := by rw [append]
+        _                 = x::(xs @ (B @ C)) := by rw [ih]
+        _                 = (x::xs) @ (B @ C) := by rw [append]
+
+-- foldl is the left-to-right loop: foldl g z [x1, ..., xn] = g(xn, ..., g(x1, z)...)
+def foldl {α β : Type} (g : α → β → β) (z : β) (l : List α) : β :=
+  match l with
+  | List.Nil => z
+  | List.Cons x xs => foldl g (g x z) xs
+
+-- rev l acc pushes l onto acc back to front. It matches on l directly rather
+-- than going through foldl, so when l is not shared each cell of l is reused
+-- for the cell pushed onto acc instead of allocating a new one.
+def rev {α : Type} (l : List α) (acc : List α) : List α :=
+  match l with
+  | List.Nil => acc
+  | List.Cons x xs => rev xs (x::acc)
+
+theorem revEqFoldl {α : Type} (l : List α) (acc : List α) : rev l acc = foldl (fun x L ↦ x::L) acc l := by
+  induction l generalizing acc with
+  | Nil => rfl
+  | Cons x xs ih => exact ih (x::acc)
+
+theorem foldlRev {α β : Type} (g : α → β → β) (z : β) (l : List α) (acc : List α) :
+  foldl g z (rev l acc) = foldl g (fold g z l) acc := by
+  induction l generalizing acc with
+  | Nil =>
+      calc
+        foldl g z (rev List.Nil acc) = foldl g z acc := by rfl
+        _                            = foldl g (fold g z List.Nil) acc := by rw [fold]
+  | Cons x xs ih =>
+      calc
+        foldl g z (rev (x::xs) acc) = foldl g z (rev xs (x::acc)) := by rfl
+        _                           = foldl g (fold g z xs) (x::acc) := by rw [ih]
+        _                           = foldl g (g x (fold g z xs)) acc := by rfl
+        _                           = foldl g (fold g z (x::xs)) acc := by rw [fold]
+
+-- The exercise from the README: len' acc l counts l on top of acc
+def len' {α : Type} (acc : Nat) : List α → Nat :=
+  foldl (fun _ tot ↦ tot + 1) acc
+
+theorem len'Equiv {α : Type} (acc : Nat) (l : List α) : len' acc l = acc + len l := by
+  induction l generalizing acc with
+  | Nil =>
+      calc
+        len' acc (List.Nil : List α) = acc := by rfl
+        _                            = acc + 0 := by rw [Nat.add_zero]
+        _                            = acc + len (List.Nil : List α) := by rw [len]
+  | Cons x xs ih =>
+      calc
+        len' acc (x::xs) = len' (acc + 1) xs := by rfl
+        _                = acc + 1 + len xs := by rw [ih]
+        _                = acc + (1 + len xs) := by rw [Nat.add_assoc]
+        _                = acc + len (x::xs) := by rw [len]
+
+def lenTR {α : Type} (l : List α) : Nat :=
+  len' 0 l
+
+theorem lenTREquiv {α : Type} (l : List α) : lenTR l = len l := by
+  rw [lenTR, len'Equiv, Nat.zero_add]
+
+-- foldTR copies l into one Array, sized up front, and folds it from the back.
+-- Reversing l with rev would also work, but on a shared l that builds n fresh
+-- cons cells just to throw them away, where the Array is a single allocation.
+
+def arrayOfList {α : Type} (arr : Array α) (l : List α) : Array α :=
+  match l with
+  | List.Nil => arr
+  | List.Cons x xs => arrayOfList (arr.push x) xs
+
+theorem arrayOfListData {α : Type} (arr : Array α) (l : List α) :
+  ofStdList (arrayOfList arr l).data = (ofStdList arr.data) @ l := by
+  induction l generalizing arr with
+  | Nil => exact (appendNil (ofStdList arr.data)).symm
+  | Cons x xs ih =>
+      calc
+        ofStdList (arrayOfList arr (x::xs)).data = ofStdList (arrayOfList (arr.push x) xs).data := by rfl
+        _                                        = (ofStdList (arr.push x).data) @ xs := by rw [ih]
+        _                                        = (ofStdList (arr.data.concat x)) @ xs := by rfl
+        _                                        = ((ofStdList arr.data) @ (x::List.Nil)) @ xs := by rw [ofStdListConcat]
+        _                                        = (ofStdList arr.data) @ ((x::List.Nil) @ xs) := by rw [appendAssoc]
+        _                                        = (ofStdList arr.data) @ (x::xs) := by rfl
+
+def foldTR {α β : Type} (g : α → β → β) (z : β) (l : List α) : β :=
+  (arrayOfList (Array.mkEmpty (lenTR l)) l).foldr g z
+
+theorem foldTREquiv {α β : Type} (g : α → β → β) (z : β) (l : List α) :
+  foldTR g z l = fold g z l := by
+  calc
+    foldTR g z l = (arrayOfList (Array.mkEmpty (lenTR l)) l).data.foldr g z := by rw [foldTR, Array.foldr_eq_foldr_data]
+    _            = fold g z (ofStdList (arrayOfList (Array.mkEmpty (lenTR l)) l).data) := by rw [foldrOfStdList]
+    _            = fold g z ((ofStdList (Array.mkEmpty (lenTR l) : Array α).data) @ l) := by rw [arrayOfListData]
+    _            = fold g z l := by rfl
+
+-- Same trick as append', but with two rev passes so an unshared A is rebuilt
+-- in place
+def appendTR {α : Type} (A : List α) (B : List α) : List α :=
+  rev (rev A List.Nil) B
+
+theorem appendTREquiv {α : Type} (A : List α) (B : List α) : appendTR A B = A @ B := by
+  calc
+    appendTR A B = foldl (fun x L ↦ x::L) B (rev A List.Nil) := revEqFoldl (rev A List.Nil) B
+    _            = foldl (fun x L ↦ x::L) (fold (fun x L ↦ x::L) B A) List.Nil := by rw [foldlRev]
+    _            = fold (fun x L ↦ x::L) B A := by rfl
+    _            = A @ B := by rw [foldAppendEquiv, append']
+
+-- mapRev f l acc pushes f x onto acc for each x in l, back to front, reusing
+-- the cells of l the same way rev does
+def mapRev {α β : Type} (f : α → β) (l : List α) (acc : List β) : List β :=
+  match l with
+  | List.Nil => acc
+  | List.Cons x xs => mapRev f xs ((f x)::acc)
+
+theorem mapRevEquiv {α β : Type} (f : α → β) (l : List α) (acc : List β) : mapRev f l acc = rev (map f l) acc := by
+  induction l generalizing acc with
+  | Nil => rfl
+  | Cons x xs ih => exact ih ((f x)::acc)
+
+def mapTR {α β : Type} (f : α → β) (l : List α) : List β :=
+  rev (mapRev f l List.Nil) List.Nil
 
+theorem mapTREquiv {α β : Type} (f : α → β) (l : List α) : mapTR f l = map f l := by
+  calc
+    mapTR f l = rev (rev (map f l) List.Nil) List.Nil := by rw [mapTR, mapRevEquiv]
+    _         = appendTR (map f l) List.Nil := by rfl
+    _         = (map f l) @ List.Nil := by rw [appendTREquiv]
+    _         = map f l := by rw [appendNil]
+
+@[csimp] theorem appendEqAppendTR : @append = @appendTR := by
+  apply funext; intro α
+  apply funext; intro A
+  apply funext; intro B
+  exact (appendTREquiv A B).symm
+
+@[csimp] theorem mapEqMapTR : @map = @mapTR := by
+  apply funext; intro α
+  apply funext; intro β
+  apply funext; intro f
+  apply funext; intro l
+  exact (mapTREquiv f l).symm
+
+@[csimp] theorem foldEqFoldTR : @fold = @foldTR := by
+  apply funext; intro α
+  apply funext; intro β
+  apply funext; intro g
+  apply funext; intro z
+  apply funext; intro l
+  exact (foldTREquiv g z l).symm
+
+@[csimp] theorem lenEqLenTR : @len = @lenTR := by
+  apply funext; intro α
+  apply funext; intro l
+  exact (lenTREquiv l).symm
 
 
 -- And here is some fun stuff using trees!
@@ -255,4 +477,209 @@ theorem trimSize {α : Type} (T : Tree α) :
             _               = 1 + size (Tree.Node LL Lx LR) + size R := by rw [← Nat.add_assoc]
             _               = size (Tree.Node (Tree.Node LL Lx LR) x R) := by rw [← size]
 
+-- inord and leaves append at every node, which goes quadratic on skewed trees.
+-- Passing the rest of the output down as an accumulator emits each element once.
+
+def inordAcc {α : Type} (t : Tree α) (acc : List α) : List α :=
+  match t with
+    | Tree.Empty => acc
+    | Tree.Node L x R => inordAcc L (x::(inordAcc R acc))
+
+def leavesAcc {α : Type} (t : Tree α) (acc : List α) : List α :=
+  match t with
+    | Tree.Empty => acc
+    | Tree.Node L x R =>
+        match (L, R) with
+        | (Tree.Empty, Tree.Empty) => x::acc
+        | _ => leavesAcc L (leavesAcc R acc)
+
+theorem inordAccEquiv {α : Type} (T : Tree α) (acc : List α) :
+  inordAcc T acc = (inord T) @ acc := by
+  induction T generalizing acc with
+  | Empty =>
+      calc
+        inordAcc Tree.Empty acc = acc := by rw [inordAcc]
+        _                       = List.Nil @ acc := by rw [append]
+        _                       = (inord Tree.Empty) @ acc := by rw [inord]
+  | Node L x R ihL ihR =>
+      calc
+        inordAcc (Tree.Node L x R) acc = inordAcc L (x::(inordAcc R acc)) := by rw [inordAcc]
+        _                              = (inord L) @ (x::((inord R) @ acc)) := by rw [ihR, ihL]
+        _                              = (inord L) @ ((x::(inord R)) @ acc) := by rw [append]
+        _                              = ((inord L) @ (x::(inord R))) @ acc := by rw [appendAssoc]
+        _                              = (inord (Tree.Node L x R)) @ acc := by rw [inord]
+
+theorem leavesAccEquiv {α : Type} (T : Tree α) (acc : List α) :
+  leavesAcc T acc = (leaves T) @ acc := by
+  induction T generalizing acc with
+  | Empty =>
+      calc
+        leavesAcc Tree.Empty acc = acc := by rfl
+        _                        = List.Nil @ acc := by rw [append]
+        _                        = (leaves Tree.Empty) @ acc := by rfl
+  | Node L x R ihL ihR =>
+      cases L with
+      | Empty =>
+          cases R with
+          | Empty =>
+              calc
+                leavesAcc (Tree.Node Tree.Empty x Tree.Empty) acc = x::acc := by rfl
+                _          = x::(List.Nil @ acc) := by rw [append]
+                _          = (x::List.Nil) @ acc := by rw [append]
+                _          = (leaves (Tree.Node Tree.Empty x Tree.Empty)) @ acc := by rfl
+          | Node RL Rx RR =>
+              calc
+                leavesAcc (Tree.Node Tree.Empty x (Tree.Node RL Rx RR)) acc =
+                            leavesAcc Tree.Empty (leavesAcc (Tree.Node RL Rx RR) acc) := by rfl
+                _          = (leaves Tree.Empty) @ ((leaves (Tree.Node RL Rx RR)) @ acc) := by rw [ihR, ihL]
+                _          = ((leaves Tree.Empty) @ (leaves (Tree.Node RL Rx RR))) @ acc := by rw [appendAssoc]
+                _          = (leaves (Tree.Node Tree.Empty x (Tree.Node RL Rx RR))) @ acc := by rfl
+      | Node LL Lx LR =>
+          calc
+            leavesAcc (Tree.Node (Tree.Node LL Lx LR) x R) acc =
+                            leavesAcc (Tree.Node LL Lx LR) (leavesAcc R acc) := by rfl
+            _               = (leaves (Tree.Node LL Lx LR)) @ ((leaves R) @ acc) := by rw [ihR, ihL]
+            _               = ((leaves (Tree.Node LL Lx LR)) @ (leaves R)) @ acc := by rw [appendAssoc]
+            _               = (leaves (Tree.Node (Tree.Node LL Lx LR) x R)) @ acc := by rfl
+
+def inordTR {α : Type} (t : Tree α) : List α :=
+  inordAcc t List.Nil
+
+def leavesTR {α : Type} (t : Tree α) : List α :=
+  leavesAcc t List.Nil
+
+theorem inordTREquiv {α : Type} (T : Tree α) : inordTR T = inord T := by
+  rw [inordTR, inordAccEquiv, appendNil]
+
+theorem leavesTREquiv {α : Type} (T : Tree α) : leavesTR T = leaves T := by
+  rw [leavesTR, leavesAccEquiv, appendNil]
+
+@[csimp] theorem inordEqInordTR : @inord = @inordTR := by
+  apply funext; intro α
+  apply funext; intro T
+  exact (inordTREquiv T).symm
+
+@[csimp] theorem leavesEqLeavesTR : @leaves = @leavesTR := by
+  apply funext; intro α
+  apply funext; intro T
+  exact (leavesTREquiv T).symm
+
+-- inordMap again, this time through the accumulator
+theorem inordAccMap {α β : Type} (T : Tree α) (f : α → β) (acc : List α) :
+  inordAcc (treeMap f T) (map f acc) = map f (inordAcc T acc) := by
+  induction T generalizing acc with
+  | Empty =>
+      calc
+        inordAcc (treeMap f Tree.Empty) (map f acc) = inordAcc Tree.Empty (map f acc) := by rw [treeMap]
+        _                                           = map f acc := by rw [inordAcc]
+        _                                           = map f (inordAcc Tree.Empty acc) := by rw [inordAcc]
+  | Node L x R ihL ihR =>
+      calc
+        inordAcc (treeMap f (Tree.Node L x R)) (map f acc) =
+                      inordAcc (Tree.Node (treeMap f L) (f x) (treeMap f R)) (map f acc) := by rw [treeMap]
+        _           = inordAcc (treeMap f L) ((f x)::(inordAcc (treeMap f R) (map f acc))) := by rw [inordAcc]
+        _           = inordAcc (treeMap f L) ((f x)::(map f (inordAcc R acc))) := by rw [ihR]
+        _           = inordAcc (treeMap f L) (map f (x::(inordAcc R acc))) := by rw [map]
+        _           = map f (inordAcc L (x::(inordAcc R acc))) := by rw [ihL]
+        _           = map f (inordAcc (Tree.Node L x R) acc) := by rw [inordAcc]
+
+theorem inordMap' {α β : Type} (T : Tree α) (f : α → β) :
+  inord (treeMap f T) = map f (inord T) := by
+  calc
+    inord (treeMap f T) = inordAcc (treeMap f T) List.Nil := by rw [inordAccEquiv, appendNil]
+    _                   = inordAcc (treeMap f T) (map f List.Nil) := by rw [map]
+    _                   = map f (inordAcc T List.Nil) := by rw [inordAccMap]
+    _                   = map f (inord T) := by rw [inordAccEquiv, appendNil]
+
+-- trim, leaves and size each walk the whole tree. trimLeavesSize T acc does all
+-- three in one pass, pushing the leaves onto acc. Every node it consumes is
+-- rebuilt with the same shape, so the compiler can reuse the cell in place.
+def trimLeavesSize {α : Type} (t : Tree α) (acc : List α) : Tree α × List α × Nat :=
+  match t with
+  | Tree.Empty => (Tree.Empty, acc, 0)
+  | Tree.Node L x R =>
+      match (L, R) with
+        | (Tree.Empty, Tree.Empty) => (Tree.Empty, x::acc, 1)
+        | _ =>
+            let r := trimLeavesSize R acc
+            let l := trimLeavesSize L r.2.1
+            (Tree.Node l.1 x r.1, l.2.1, 1 + l.2.2 + r.2.2)
+
+theorem trimLeavesSizeEquiv {α : Type} (T : Tree α) (acc : List α) :
+  trimLeavesSize T acc = (trim T, (leaves T) @ acc, size T) := by
+  induction T generalizing acc with
+  | Empty =>
+      calc
+        trimLeavesSize Tree.Empty acc = (Tree.Empty, acc, 0) := by rfl
+        _                             = (Tree.Empty, List.Nil @ acc, 0) := by rw [append]
+        _                             = (trim Tree.Empty, (leaves Tree.Empty) @ acc, size Tree.Empty) := by rfl
+  | Node L x R ihL ihR =>
+      cases L with
+      | Empty =>
+          cases R with
+          | Empty =>
+              calc
+                trimLeavesSize (Tree.Node Tree.Empty x Tree.Empty) acc = (Tree.Empty, x::acc, 1) := by rfl
+                _          = (Tree.Empty, (x::List.Nil) @ acc, 1) := by rw [append, append]
+                _          = (trim (Tree.Node Tree.Empty x Tree.Empty), (leaves (Tree.Node Tree.Empty x Tree.Empty)) @ acc,
+                                size (Tree.Node Tree.Empty x Tree.Empty)) := by rfl
+          | Node RL Rx RR =>
+              calc
+                trimLeavesSize (Tree.Node Tree.Empty x (Tree.Node RL Rx RR)) acc =
+                            (Tree.Node (trimLeavesSize Tree.Empty (trimLeavesSize (Tree.Node RL Rx RR) acc).2.1).1 x (trimLeavesSize (Tree.Node RL Rx RR) acc).1,
+                              (trimLeavesSize Tree.Empty (trimLeavesSize (Tree.Node RL Rx RR) acc).2.1).2.1,
+                              1 + (trimLeavesSize Tree.Empty (trimLeavesSize (Tree.Node RL Rx RR) acc).2.1).2.2 + (trimLeavesSize (Tree.Node RL Rx RR) acc).2.2) := by rfl
+                _          = (Tree.Node (trim Tree.Empty) x (trim (Tree.Node RL Rx RR)), (leaves Tree.Empty) @ ((leaves (Tree.Node RL Rx RR)) @ acc),
+                                1 + size (Tree.Empty : Tree α) + size (Tree.Node RL Rx RR)) := by rw [ihR, ihL]
+                _          = (Tree.Node (trim Tree.Empty) x (trim (Tree.Node RL Rx RR)), ((leaves Tree.Empty) @ (leaves (Tree.Node RL Rx RR))) @ acc,
+                                1 + size (Tree.Empty : Tree α) + size (Tree.Node RL Rx RR)) := by rw [appendAssoc]
+                _          = (trim (Tree.Node Tree.Empty x (Tree.Node RL Rx RR)), (leaves (Tree.Node Tree.Empty x (Tree.Node RL Rx RR))) @ acc,
+                                size (Tree.Node Tree.Empty x (Tree.Node RL Rx RR))) := by rfl
+      | Node LL Lx LR =>
+          calc
+            trimLeavesSize (Tree.Node (Tree.Node LL Lx LR) x R) acc =
+                            (Tree.Node (trimLeavesSize (Tree.Node LL Lx LR) (trimLeavesSize R acc).2.1).1 x (trimLeavesSize R acc).1,
+                              (trimLeavesSize (Tree.Node LL Lx LR) (trimLeavesSize R acc).2.1).2.1,
+                              1 + (trimLeavesSize (Tree.Node LL Lx LR) (trimLeavesSize R acc).2.1).2.2 + (trimLeavesSize R acc).2.2) := by rfl
+            _               = (Tree.Node (trim (Tree.Node LL Lx LR)) x (trim R), (leaves (Tree.Node LL Lx LR)) @ ((leaves R) @ acc),
+                                1 + size (Tree.Node LL Lx LR) + size R) := by rw [ihR, ihL]
+            _               = (Tree.Node (trim (Tree.Node LL Lx LR)) x (trim R), ((leaves (Tree.Node LL Lx LR)) @ (leaves R)) @ acc,
+                                1 + size (Tree.Node LL Lx LR) + size R) := by rw [appendAssoc]
+            _               = (trim (Tree.Node (Tree.Node LL Lx LR) x R), (leaves (Tree.Node (Tree.Node LL Lx LR) x R)) @ acc,
+                                size (Tree.Node (Tree.Node LL Lx LR) x R)) := by rfl
+
+-- The bookkeeping at an internal node: both children keep the invariant, so the node does too
+theorem trimLeavesSizeStep {sL nL cL sR nR cR la : Nat}
+  (hL : sL + nL = cL + nR) (hR : sR + nR = cR + la) :
+  1 + sL + sR + nL = 1 + cL + cR + la := by
+  calc
+    1 + sL + sR + nL = 1 + sL + nL + sR := by rw [Nat.add_right_comm (1 + sL) sR nL]
+    _                = 1 + (sL + nL) + sR := by rw [Nat.add_assoc 1 sL nL]
+    _                = 1 + (cL + nR) + sR := by rw [hL]
+    _                = 1 + cL + nR + sR := by rw [Nat.add_assoc 1 cL nR]
+    _                = 1 + cL + (sR + nR) := by rw [Nat.add_assoc (1 + cL) nR sR, Nat.add_comm nR sR]
+    _                = 1 + cL + (cR + la) := by rw [hR]
+    _                = 1 + cL + cR + la := by rw [Nat.add_assoc (1 + cL) cR la]
+
+-- Whatever trimLeavesSize drops from the tree shows up on the leaf list, and
+-- the count covers both
+theorem trimLeavesSizeInv {α : Type} (T : Tree α) (acc : List α) :
+  size (trimLeavesSize T acc).1 + len (trimLeavesSize T acc).2.1 = (trimLeavesSize T acc).2.2 + len acc := by
+  induction T generalizing acc with
+  | Empty => rfl
+  | Node L x R ihL ihR =>
+      cases L with
+      | Empty =>
+          cases R with
+          | Empty => exact Nat.zero_add (1 + len acc)
+          | Node RL Rx RR => exact trimLeavesSizeStep (ihL (trimLeavesSize (Tree.Node RL Rx RR) acc).2.1) (ihR acc)
+      | Node LL Lx LR => exact trimLeavesSizeStep (ihL (trimLeavesSize R acc).2.1) (ihR acc)
+
+-- And trimSize falls out by starting from an empty leaf list
+theorem trimSize' {α : Type} (T : Tree α) :
+  size (trim T) + len (leaves T) = size T := by
+  have h := trimLeavesSizeInv T List.Nil
+  simp only [trimLeavesSizeEquiv, appendNil, len, Nat.add_zero] at h
+  exact h
+
 end structural_datatypes
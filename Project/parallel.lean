@@ -0,0 +1,59 @@
+import Project.midterm
+
+namespace structural_datatypes
+
+-- treeMap f (Node L x R) maps L and R independently, so the two halves can run
+-- on different cores. Above the cutoff depth every subtree becomes a Task and
+-- the parents are put back together as the children finish; below it we fall
+-- back to the sequential code, so we never spawn more than 2^cutoff tasks.
+
+def treeMapTask {α β : Type} (cutoff : Nat) (f : α → β) (t : Tree α) : Task (Tree β) :=
+  match cutoff, t with
+    | 0, t => Task.spawn fun _ => treeMap f t
+    | _, Tree.Empty => Task.pure Tree.Empty
+    | n+1, Tree.Node L x R =>
+        let l := treeMapTask n f L
+        let r := treeMapTask n f R
+        l.bind fun L' => r.map fun R' => Tree.Node L' (f x) R'
+
+def treeMapPar {α β : Type} (cutoff : Nat) (f : α → β) (t : Tree α) : Tree β :=
+  (treeMapTask cutoff f t).get
+
+theorem treeMapParEquiv {α β : Type} (cutoff : Nat) (f : α → β) (T : Tree α) :
+  treeMapPar cutoff f T = treeMap f T := by
+  induction cutoff generalizing T with
+  | zero => rfl
+  | succ n ih =>
+      cases T with
+      | Empty => rfl
+      | Node L x R =>
+          calc
+            treeMapPar (n+1) f (Tree.Node L x R) = Tree.Node (treeMapPar n f L) (f x) (treeMapPar n f R) := by rfl
+            _                                    = Tree.Node (treeMap f L) (f x) (treeMap f R) := by rw [ih L, ih R]
+            _                                    = treeMap f (Tree.Node L x R) := by rfl
+
+def sizeTask {α : Type} (cutoff : Nat) (t : Tree α) : Task Nat :=
+  match cutoff, t with
+    | 0, t => Task.spawn fun _ => size t
+    | _, Tree.Empty => Task.pure 0
+    | n+1, Tree.Node L _ R =>
+        let l := sizeTask n L
+        let r := sizeTask n R
+        l.bind fun nL => r.map fun nR => 1 + nL + nR
+
+def sizePar {α : Type} (cutoff : Nat) (t : Tree α) : Nat :=
+  (sizeTask cutoff t).get
+
+theorem sizeParEquiv {α : Type} (cutoff : Nat) (T : Tree α) : sizePar cutoff T = size T := by
+  induction cutoff generalizing T with
+  | zero => rfl
+  | succ n ih =>
+      cases T with
+      | Empty => rfl
+      | Node L x R =>
+          calc
+            sizePar (n+1) (Tree.Node L x R) = 1 + sizePar n L + sizePar n R := by rfl
+            _                               = 1 + size L + size R := by rw [ih L, ih R]
+            _                               = size (Tree.Node L x R) := by rfl
+
+end structural_datatypes
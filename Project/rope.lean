@@ -0,0 +1,217 @@
+import Project.midterm
+
+namespace structural_datatypes
+
+-- append copies its whole left argument, so building a list with repeated
+-- acc @ chunk is quadratic. A Rope just remembers the appends as Cat nodes,
+-- which makes ++ O(1), and only turns into a List when something looks at it.
+
+inductive Rope (α : Type) where
+  | Nil : Rope α
+  | Leaf : List α → Rope α
+  | Cat : Rope α → Rope α → Rope α
+
+def ropeOf {α : Type} (l : List α) : Rope α :=
+  Rope.Leaf l
+
+-- The List a rope stands for
+def flatten {α : Type} (r : Rope α) : List α :=
+  match r with
+    | Rope.Nil => List.Nil
+    | Rope.Leaf l => l
+    | Rope.Cat r s => (flatten r) @ (flatten s)
+
+-- flatten re-appends at every Cat, just like inord did, so the compiled
+-- version passes the rest of the output down instead
+def flattenAcc {α : Type} (r : Rope α) (acc : List α) : List α :=
+  match r with
+    | Rope.Nil => acc
+    | Rope.Leaf l =>
+        match acc with
+          | List.Nil => l
+          | List.Cons _ _ => l @ acc
+    | Rope.Cat r s => flattenAcc r (flattenAcc s acc)
+
+theorem flattenAccEquiv {α : Type} (r : Rope α) (acc : List α) : flattenAcc r acc = (flatten r) @ acc := by
+  induction r generalizing acc with
+  | Nil =>
+      calc
+        flattenAcc Rope.Nil acc = acc := by rfl
+        _                       = List.Nil @ acc := by rw [append]
+        _                       = (flatten (Rope.Nil : Rope α)) @ acc := by rfl
+  | Leaf l =>
+      cases acc with
+      | Nil => exact (appendNil l).symm
+      | Cons y ys => rfl
+  | Cat r s ihr ihs =>
+      calc
+        flattenAcc (Rope.Cat r s) acc = flattenAcc r (flattenAcc s acc) := by rfl
+        _                             = (flatten r) @ ((flatten s) @ acc) := by rw [ihs, ihr]
+        _                             = ((flatten r) @ (flatten s)) @ acc := by rw [appendAssoc]
+        _                             = (flatten (Rope.Cat r s)) @ acc := by rfl
+
+def flattenTR {α : Type} (r : Rope α) : List α :=
+  flattenAcc r List.Nil
+
+theorem flattenTREquiv {α : Type} (r : Rope α) : flattenTR r = flatten r := by
+  rw [flattenTR, flattenAccEquiv, appendNil]
+
+@[csimp] theorem flattenEqFlattenTR : @flatten = @flattenTR := by
+  apply funext; intro α
+  apply funext; intro r
+  exact (flattenTREquiv r).symm
+
+def ropeAppend {α : Type} (r : Rope α) (s : Rope α) : Rope α :=
+  Rope.Cat r s
+
+-- Ropes get ++ through Append rather than their own @, so @ always means List
+-- append and never has two readings
+instance {α : Type} : Append (Rope α) := ⟨ropeAppend⟩
+
+theorem flattenOf {α : Type} (l : List α) : flatten (ropeOf l) = l := rfl
+
+theorem flattenAppend {α : Type} (r : Rope α) (s : Rope α) : flatten (r ++ s) = (flatten r) @ (flatten s) := rfl
+
+-- fold, map and len walk the Cat nodes directly, without flattening first.
+-- fold and len recurse on the left rope in tail position, so the left-nested
+-- ropes built by repeated acc ++ chunk don't grow the stack. map has to rebuild
+-- the Cat nodes around its results, so its compiled version is ropeMapSpine
+-- below.
+
+def ropeFold {α β : Type} (g : α → β → β) (z : β) (r : Rope α) : β :=
+  match r with
+    | Rope.Nil => z
+    | Rope.Leaf l => fold g z l
+    | Rope.Cat r s => ropeFold g (ropeFold g z s) r
+
+def ropeMap {α β : Type} (f : α → β) (r : Rope α) : Rope β :=
+  match r with
+    | Rope.Nil => Rope.Nil
+    | Rope.Leaf l => Rope.Leaf (map f l)
+    | Rope.Cat r s => Rope.Cat (ropeMap f r) (ropeMap f s)
+
+def ropeLenAcc {α : Type} (r : Rope α) (acc : Nat) : Nat :=
+  match r with
+    | Rope.Nil => acc
+    | Rope.Leaf l => len l + acc
+    | Rope.Cat r s => ropeLenAcc r (ropeLenAcc s acc)
+
+def ropeLen {α : Type} (r : Rope α) : Nat :=
+  ropeLenAcc r 0
+
+theorem ropeFoldEquiv {α β : Type} (g : α → β → β) (z : β) (r : Rope α) :
+  ropeFold g z r = fold g z (flatten r) := by
+  induction r generalizing z with
+  | Nil => rfl
+  | Leaf l => rfl
+  | Cat r s ihr ihs =>
+      calc
+        ropeFold g z (Rope.Cat r s) = ropeFold g (ropeFold g z s) r := by rfl
+        _                           = fold g (fold g z (flatten s)) (flatten r) := by rw [ihs, ihr]
+        _                           = fold g z ((flatten r) @ (flatten s)) := by rw [foldAppend]
+        _                           = fold g z (flatten (Rope.Cat r s)) := by rfl
+
+theorem ropeMapEquiv {α β : Type} (f : α → β) (r : Rope α) :
+  flatten (ropeMap f r) = map f (flatten r) := by
+  induction r with
+  | Nil => rfl
+  | Leaf l => rfl
+  | Cat r s ihr ihs =>
+      calc
+        flatten (ropeMap f (Rope.Cat r s)) = (flatten (ropeMap f r)) @ (flatten (ropeMap f s)) := by rfl
+        _                                  = (map f (flatten r)) @ (map f (flatten s)) := by rw [ihr, ihs]
+        _                                  = map f ((flatten r) @ (flatten s)) := by rw [mapAppend]
+        _                                  = map f (flatten (Rope.Cat r s)) := by rfl
+
+-- ropeCatAll r [s1, ..., sn] = r ++ s1 ++ ... ++ sn, nested to the left
+def ropeCatAll {α : Type} (r : Rope α) (rights : List (Rope α)) : Rope α :=
+  match rights with
+    | List.Nil => r
+    | List.Cons s ss => ropeCatAll (Rope.Cat r s) ss
+
+-- ropeMapSpine walks down the left spine in tail position, keeping the mapped
+-- right children in rights, and rebuilds the Cat nodes at the bottom. Only
+-- right nesting uses the stack.
+def ropeMapSpine {α β : Type} (f : α → β) (r : Rope α) (rights : List (Rope β)) : Rope β :=
+  match r with
+    | Rope.Nil => ropeCatAll Rope.Nil rights
+    | Rope.Leaf l => ropeCatAll (Rope.Leaf (map f l)) rights
+    | Rope.Cat r s => ropeMapSpine f r ((ropeMapSpine f s List.Nil)::rights)
+
+theorem ropeMapSpineEquiv {α β : Type} (f : α → β) (r : Rope α) (rights : List (Rope β)) :
+  ropeMapSpine f r rights = ropeCatAll (ropeMap f r) rights := by
+  induction r generalizing rights with
+  | Nil => rfl
+  | Leaf l => rfl
+  | Cat r s ihr ihs =>
+      calc
+        ropeMapSpine f (Rope.Cat r s) rights = ropeMapSpine f r ((ropeMapSpine f s List.Nil)::rights) := by rfl
+        _                                    = ropeMapSpine f r ((ropeCatAll (ropeMap f s) List.Nil)::rights) := by rw [ihs]
+        _                                    = ropeMapSpine f r ((ropeMap f s)::rights) := by rfl
+        _                                    = ropeCatAll (ropeMap f r) ((ropeMap f s)::rights) := by rw [ihr]
+        _                                    = ropeCatAll (ropeMap f (Rope.Cat r s)) rights := by rfl
+
+def ropeMapTR {α β : Type} (f : α → β) (r : Rope α) : Rope β :=
+  ropeMapSpine f r List.Nil
+
+theorem ropeMapTREquiv {α β : Type} (f : α → β) (r : Rope α) : ropeMapTR f r = ropeMap f r :=
+  ropeMapSpineEquiv f r List.Nil
+
+@[csimp] theorem ropeMapEqRopeMapTR : @ropeMap = @ropeMapTR := by
+  apply funext; intro α
+  apply funext; intro β
+  apply funext; intro f
+  apply funext; intro r
+  exact (ropeMapTREquiv f r).symm
+
+theorem ropeLenAccEquiv {α : Type} (r : Rope α) (acc : Nat) : ropeLenAcc r acc = len (flatten r) + acc := by
+  induction r generalizing acc with
+  | Nil => exact (Nat.zero_add acc).symm
+  | Leaf l => rfl
+  | Cat r s ihr ihs =>
+      calc
+        ropeLenAcc (Rope.Cat r s) acc = ropeLenAcc r (ropeLenAcc s acc) := by rfl
+        _                             = len (flatten r) + (len (flatten s) + acc) := by rw [ihs, ihr]
+        _                             = len (flatten r) + len (flatten s) + acc := by rw [Nat.add_assoc]
+        _                             = len ((flatten r) @ (flatten s)) + acc := by rw [lenAppend]
+        _                             = len (flatten (Rope.Cat r s)) + acc := by rfl
+
+theorem ropeLenEquiv {α : Type} (r : Rope α) : ropeLen r = len (flatten r) := by
+  rw [ropeLen, ropeLenAccEquiv, Nat.add_zero]
+
+-- At the rope level foldAppend and mapAppend hold by definition
+
+theorem ropeFoldAppend {α β : Type} (r : Rope α) (s : Rope α) (g : α → β → β) (z : β) :
+  ropeFold g z (r ++ s) = ropeFold g (ropeFold g z s) r := rfl
+
+theorem ropeMapAppend {α β : Type} (r : Rope α) (s : Rope α) (f : α → β) :
+  ropeMap f (r ++ s) = (ropeMap f r) ++ (ropeMap f s) := rfl
+
+-- A rope that flattens itself the first time it is read and keeps the result,
+-- so later reads are free
+
+structure LazyRope (α : Type) where
+  rope : Rope α
+  flat : Thunk (List α)
+  flatEq : flat.get = flatten rope
+
+def lazyRope {α : Type} (r : Rope α) : LazyRope α :=
+  ⟨r, Thunk.mk fun _ => flattenTR r, flattenTREquiv r⟩
+
+def lazyRopeAppend {α : Type} (a : LazyRope α) (b : LazyRope α) : LazyRope α :=
+  lazyRope (a.rope ++ b.rope)
+
+def lazyRopeToList {α : Type} (a : LazyRope α) : List α :=
+  a.flat.get
+
+theorem lazyRopeToListEquiv {α : Type} (a : LazyRope α) : lazyRopeToList a = flatten a.rope :=
+  a.flatEq
+
+theorem lazyRopeAppendEquiv {α : Type} (a : LazyRope α) (b : LazyRope α) :
+  lazyRopeToList (lazyRopeAppend a b) = (lazyRopeToList a) @ (lazyRopeToList b) := by
+  calc
+    lazyRopeToList (lazyRopeAppend a b) = flatten (a.rope ++ b.rope) := lazyRopeToListEquiv (lazyRopeAppend a b)
+    _                                   = (flatten a.rope) @ (flatten b.rope) := by rfl
+    _                                   = (lazyRopeToList a) @ (lazyRopeToList b) := by rw [lazyRopeToListEquiv, lazyRopeToListEquiv]
+
+end structural_datatypes
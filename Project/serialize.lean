@@ -0,0 +1,171 @@
+import Project.midterm
+
+namespace structural_datatypes
+
+-- A compact binary format for Lists and Trees of UInt64, so we can load them
+-- from a ByteArray instead of rebuilding them node by node.
+--
+-- A List is "SDL1", its length, then each element, all as little-endian
+-- UInt64s. A Tree is "SDT1" followed by its nodes in postorder: an Empty is
+-- the byte 0, and a Node is the byte 1 followed by its element. Postorder
+-- means the reader never recurses: it keeps the finished subtrees on a stack
+-- and every Node pops its two children off it.
+
+-- First the idea, on a list of tokens instead of bytes
+
+inductive TreeToken (α : Type) where
+  | Empty : TreeToken α
+  | Node : α → TreeToken α
+
+def treeTokens {α : Type} (t : Tree α) : List (TreeToken α) :=
+  match t with
+    | Tree.Empty => TreeToken.Empty::List.Nil
+    | Tree.Node L x R => (treeTokens L) @ ((treeTokens R) @ ((TreeToken.Node x)::List.Nil))
+
+def runTokens {α : Type} (toks : List (TreeToken α)) (stack : List (Tree α)) : Option (List (Tree α)) :=
+  match toks with
+    | List.Nil => some stack
+    | List.Cons TreeToken.Empty rest => runTokens rest (Tree.Empty::stack)
+    | List.Cons (TreeToken.Node x) rest =>
+        match stack with
+          | List.Cons R (List.Cons L st) => runTokens rest ((Tree.Node L x R)::st)
+          | _ => none
+
+def decodeTokens {α : Type} (toks : List (TreeToken α)) : Option (Tree α) :=
+  match runTokens toks List.Nil with
+    | some (List.Cons t List.Nil) => some t
+    | _ => none
+
+-- Reading a tree's tokens pushes exactly that tree
+theorem runTreeTokens {α : Type} (t : Tree α) (rest : List (TreeToken α)) (stack : List (Tree α)) :
+  runTokens ((treeTokens t) @ rest) stack = runTokens rest (t::stack) := by
+  induction t generalizing rest stack with
+  | Empty => rfl
+  | Node L x R ihL ihR =>
+      calc
+        runTokens ((treeTokens (Tree.Node L x R)) @ rest) stack =
+                    runTokens (((treeTokens L) @ ((treeTokens R) @ ((TreeToken.Node x)::List.Nil))) @ rest) stack := by rfl
+        _         = runTokens ((treeTokens L) @ ((treeTokens R) @ (((TreeToken.Node x)::List.Nil) @ rest))) stack := by rw [appendAssoc, appendAssoc]
+        _         = runTokens ((treeTokens R) @ (((TreeToken.Node x)::List.Nil) @ rest)) (L::stack) := by rw [ihL]
+        _         = runTokens (((TreeToken.Node x)::List.Nil) @ rest) (R::(L::stack)) := by rw [ihR]
+        _         = runTokens rest ((Tree.Node L x R)::stack) := by rfl
+
+theorem decodeTreeTokens {α : Type} (t : Tree α) : decodeTokens (treeTokens t) = some t := by
+  have h : runTokens (treeTokens t) List.Nil = some (t::List.Nil) := by
+    calc
+      runTokens (treeTokens t) List.Nil = runTokens ((treeTokens t) @ List.Nil) List.Nil := by rw [appendNil]
+      _                                 = runTokens List.Nil (t::List.Nil) := by rw [runTreeTokens]
+      _                                 = some (t::List.Nil) := by rfl
+  simp only [decodeTokens, h]
+
+-- Now the same thing on bytes. These are what the compiled code runs; the
+-- round trip is checked by `lake exe serialbench` rather than proven.
+
+def listMagic : ByteArray := ⟨#[0x53, 0x44, 0x4C, 0x31]⟩
+def treeMagic : ByteArray := ⟨#[0x53, 0x44, 0x54, 0x31]⟩
+def tagEmpty : UInt8 := 0
+def tagNode : UInt8 := 1
+
+def pushU64 (b : ByteArray) (x : UInt64) : ByteArray :=
+  b.push x.toUInt8 |>.push (x >>> 8).toUInt8 |>.push (x >>> 16).toUInt8 |>.push (x >>> 24).toUInt8
+    |>.push (x >>> 32).toUInt8 |>.push (x >>> 40).toUInt8 |>.push (x >>> 48).toUInt8 |>.push (x >>> 56).toUInt8
+
+def readU64 (b : ByteArray) (i : Nat) : UInt64 :=
+  (b.get! i).toUInt64 ||| ((b.get! (i+1)).toUInt64 <<< 8) ||| ((b.get! (i+2)).toUInt64 <<< 16) ||| ((b.get! (i+3)).toUInt64 <<< 24)
+    ||| ((b.get! (i+4)).toUInt64 <<< 32) ||| ((b.get! (i+5)).toUInt64 <<< 40) ||| ((b.get! (i+6)).toUInt64 <<< 48) ||| ((b.get! (i+7)).toUInt64 <<< 56)
+
+def hasMagic (b : ByteArray) (magic : ByteArray) : Bool :=
+  b.size ≥ 4 && b.get! 0 == magic.get! 0 && b.get! 1 == magic.get! 1 && b.get! 2 == magic.get! 2 && b.get! 3 == magic.get! 3
+
+-- Writing. Each writer appends to buf until it reaches limit, then hands back
+-- what is left to write, so a caller can flush buf and carry on.
+
+def encodeListChunk (limit : Nat) (buf : ByteArray) (l : List UInt64) : ByteArray × List UInt64 :=
+  match l with
+    | List.Nil => (buf, List.Nil)
+    | List.Cons x xs => if buf.size ≥ limit then (buf, l) else encodeListChunk limit (pushU64 buf x) xs
+
+def encodeListHeader (l : List UInt64) : ByteArray :=
+  pushU64 listMagic (len l).toUInt64
+
+def encodeList (l : List UInt64) : ByteArray :=
+  (encodeListChunk UInt64.size (encodeListHeader l) l).1
+
+-- What is left of the postorder walk: subtrees still to visit and elements
+-- whose children have already been written
+inductive EncodeItem where
+  | visit : Tree UInt64 → EncodeItem
+  | emit : UInt64 → EncodeItem
+
+partial def encodeTreeChunk (limit : Nat) (buf : ByteArray) (work : Array EncodeItem) : ByteArray × Array EncodeItem :=
+  if buf.size ≥ limit then (buf, work) else
+  match work.back? with
+    | none => (buf, work)
+    | some (EncodeItem.visit Tree.Empty) => encodeTreeChunk limit (buf.push tagEmpty) work.pop
+    | some (EncodeItem.visit (Tree.Node L x R)) =>
+        encodeTreeChunk limit buf (work.pop.push (EncodeItem.emit x) |>.push (EncodeItem.visit R) |>.push (EncodeItem.visit L))
+    | some (EncodeItem.emit x) => encodeTreeChunk limit (pushU64 (buf.push tagNode) x) work.pop
+
+-- No ByteArray gets to UInt64.size bytes, so that limit is never hit
+def encodeTree (t : Tree UInt64) : ByteArray :=
+  (encodeTreeChunk UInt64.size treeMagic #[EncodeItem.visit t]).1
+
+-- Streaming versions that flush to a handle every chunkSize bytes. A chunk
+-- has to hold at least one byte, or the writers would never make progress.
+
+partial def writeListChunks (h : IO.FS.Handle) (chunkSize : Nat) (buf : ByteArray) (l : List UInt64) : IO Unit := do
+  let (buf, rest) := encodeListChunk chunkSize buf l
+  h.write buf
+  match rest with
+    | List.Nil => pure ()
+    | List.Cons _ _ => writeListChunks h chunkSize ByteArray.empty rest
+
+def writeList (h : IO.FS.Handle) (l : List UInt64) (chunkSize : Nat := 65536) : IO Unit :=
+  writeListChunks h (max chunkSize 1) (encodeListHeader l) l
+
+partial def writeTreeChunks (h : IO.FS.Handle) (chunkSize : Nat) (buf : ByteArray) (work : Array EncodeItem) : IO Unit := do
+  let (buf, work) := encodeTreeChunk chunkSize buf work
+  h.write buf
+  if !work.isEmpty then writeTreeChunks h chunkSize ByteArray.empty work
+
+def writeTree (h : IO.FS.Handle) (t : Tree UInt64) (chunkSize : Nat := 65536) : IO Unit :=
+  writeTreeChunks h (max chunkSize 1) treeMagic #[EncodeItem.visit t]
+
+-- Reading. Both readers are loops: the List reader conses from the last
+-- element back to the first so the result comes out in order, and the Tree
+-- reader keeps its pending subtrees on an Array.
+
+def decodeListFrom (b : ByteArray) (k : Nat) (acc : List UInt64) : List UInt64 :=
+  match k with
+    | 0 => acc
+    | k+1 => decodeListFrom b k ((readU64 b (12 + 8 * k))::acc)
+
+def decodeList (b : ByteArray) : Option (List UInt64) :=
+  if !hasMagic b listMagic || b.size < 12 then none else
+  let n := (readU64 b 4).toNat
+  if b.size != 12 + 8 * n then none else some (decodeListFrom b n List.Nil)
+
+-- Every step eats at least one byte, so b.size + 1 steps is always enough
+def decodeTreeFrom (b : ByteArray) (fuel : Nat) (pos : Nat) (stack : Array (Tree UInt64)) : Option (Tree UInt64) :=
+  match fuel with
+    | 0 => none
+    | fuel+1 =>
+        if pos ≥ b.size then
+          if pos == b.size && stack.size == 1 then stack.back? else none
+        else
+          let tag := b.get! pos
+          if tag == tagEmpty then decodeTreeFrom b fuel (pos + 1) (stack.push Tree.Empty)
+          else if tag == tagNode && pos + 9 ≤ b.size then
+            match stack.back? with
+              | none => none
+              | some R =>
+                  let stack := stack.pop
+                  match stack.back? with
+                    | none => none
+                    | some L => decodeTreeFrom b fuel (pos + 9) (stack.pop.push (Tree.Node L (readU64 b (pos + 1)) R))
+          else none
+
+def decodeTree (b : ByteArray) : Option (Tree UInt64) :=
+  if !hasMagic b treeMagic then none else decodeTreeFrom b (b.size + 1) 4 #[]
+
+end structural_datatypes
@@ -0,0 +1,216 @@
+import Project.midterm
+
+namespace structural_datatypes
+
+-- size walks the whole tree every time we ask. A SizedTree keeps the size of
+-- every subtree in its Node, so asking is O(1)
+
+inductive SizedTree (α : Type) where
+  | Empty : SizedTree α
+  | Node : SizedTree α → α → SizedTree α → Nat → SizedTree α
+
+-- Forget the cached sizes
+def toTree {α : Type} (t : SizedTree α) : Tree α :=
+  match t with
+    | SizedTree.Empty => Tree.Empty
+    | SizedTree.Node L x R _ => Tree.Node (toTree L) x (toTree R)
+
+def sizedSize {α : Type} (t : SizedTree α) : Nat :=
+  match t with
+    | SizedTree.Empty => 0
+    | SizedTree.Node _ _ _ n => n
+
+-- Smart constructors, which fill in the size from the children
+def sizedNode {α : Type} (L : SizedTree α) (x : α) (R : SizedTree α) : SizedTree α :=
+  SizedTree.Node L x R (1 + sizedSize L + sizedSize R)
+
+def sizedLeaf {α : Type} (x : α) : SizedTree α :=
+  sizedNode SizedTree.Empty x SizedTree.Empty
+
+-- Every cached size is the size of its subtree
+def sizedValid {α : Type} (t : SizedTree α) : Prop :=
+  match t with
+    | SizedTree.Empty => True
+    | SizedTree.Node L _ R n => n = 1 + size (toTree L) + size (toTree R) ∧ sizedValid L ∧ sizedValid R
+
+theorem sizedValidNode {α : Type} {L R : SizedTree α} {x : α} {n : Nat} (h : sizedValid (SizedTree.Node L x R n)) :
+  n = 1 + size (toTree L) + size (toTree R) ∧ sizedValid L ∧ sizedValid R := h
+
+theorem sizedSizeEquiv {α : Type} (t : SizedTree α) (h : sizedValid t) : sizedSize t = size (toTree t) := by
+  cases t with
+  | Empty => rfl
+  | Node L x R n => exact (sizedValidNode h).1
+
+theorem sizedNodeValid {α : Type} (L : SizedTree α) (x : α) (R : SizedTree α) (hL : sizedValid L) (hR : sizedValid R) :
+  sizedValid (sizedNode L x R) := by
+  have hn : 1 + sizedSize L + sizedSize R = 1 + size (toTree L) + size (toTree R) := by
+    rw [sizedSizeEquiv L hL, sizedSizeEquiv R hR]
+  show 1 + sizedSize L + sizedSize R = 1 + size (toTree L) + size (toTree R) ∧ sizedValid L ∧ sizedValid R
+  exact ⟨hn, hL, hR⟩
+
+-- Converting from a plain tree
+
+def ofTree {α : Type} (T : Tree α) : SizedTree α :=
+  match T with
+    | Tree.Empty => SizedTree.Empty
+    | Tree.Node L x R => sizedNode (ofTree L) x (ofTree R)
+
+theorem toTreeOfTree {α : Type} (T : Tree α) : toTree (ofTree T) = T := by
+  induction T with
+  | Empty => rfl
+  | Node L x R ihL ihR =>
+      calc
+        toTree (ofTree (Tree.Node L x R)) = Tree.Node (toTree (ofTree L)) x (toTree (ofTree R)) := by rfl
+        _                                 = Tree.Node L x R := by rw [ihL, ihR]
+
+theorem ofTreeValid {α : Type} (T : Tree α) : sizedValid (ofTree T) := by
+  induction T with
+  | Empty => trivial
+  | Node L x R ihL ihR => exact sizedNodeValid (ofTree L) x (ofTree R) ihL ihR
+
+theorem sizedSizeOfTree {α : Type} (T : Tree α) : sizedSize (ofTree T) = size T := by
+  rw [sizedSizeEquiv (ofTree T) (ofTreeValid T), toTreeOfTree]
+
+-- treeMap never changes the shape, so the cached sizes carry over untouched
+
+def sizedMap {α β : Type} (f : α → β) (t : SizedTree α) : SizedTree β :=
+  match t with
+    | SizedTree.Empty => SizedTree.Empty
+    | SizedTree.Node L x R n => SizedTree.Node (sizedMap f L) (f x) (sizedMap f R) n
+
+theorem toTreeSizedMap {α β : Type} (f : α → β) (t : SizedTree α) :
+  toTree (sizedMap f t) = treeMap f (toTree t) := by
+  induction t with
+  | Empty => rfl
+  | Node L x R n ihL ihR =>
+      calc
+        toTree (sizedMap f (SizedTree.Node L x R n)) = Tree.Node (toTree (sizedMap f L)) (f x) (toTree (sizedMap f R)) := by rfl
+        _                                            = Tree.Node (treeMap f (toTree L)) (f x) (treeMap f (toTree R)) := by rw [ihL, ihR]
+        _                                            = treeMap f (toTree (SizedTree.Node L x R n)) := by rfl
+
+theorem sizeTreeMap {α β : Type} (T : Tree α) (f : α → β) : size (treeMap f T) = size T := by
+  induction T with
+  | Empty => rfl
+  | Node L x R ihL ihR =>
+      calc
+        size (treeMap f (Tree.Node L x R)) = 1 + size (treeMap f L) + size (treeMap f R) := by rfl
+        _                                  = 1 + size L + size R := by rw [ihL, ihR]
+        _                                  = size (Tree.Node L x R) := by rfl
+
+theorem sizedMapValid {α β : Type} (f : α → β) (t : SizedTree α) :
+  sizedValid t → sizedValid (sizedMap f t) := by
+  induction t with
+  | Empty => intro _; trivial
+  | Node L x R n ihL ihR =>
+      intro h
+      have h' := sizedValidNode h
+      show n = 1 + size (toTree (sizedMap f L)) + size (toTree (sizedMap f R)) ∧ sizedValid (sizedMap f L) ∧ sizedValid (sizedMap f R)
+      rw [toTreeSizedMap, toTreeSizedMap, sizeTreeMap, sizeTreeMap]
+      exact ⟨h'.1, ihL h'.2.1, ihR h'.2.2⟩
+
+theorem sizedInordMap {α β : Type} (t : SizedTree α) (f : α → β) :
+  inord (toTree (sizedMap f t)) = map f (inord (toTree t)) := by
+  rw [toTreeSizedMap, inordMap]
+
+-- trim rebuilds each surviving node with sizedNode, which reads the new sizes
+-- off the already trimmed children instead of recounting them
+
+def sizedTrim {α : Type} (t : SizedTree α) : SizedTree α :=
+  match t with
+  | SizedTree.Empty => SizedTree.Empty
+  | SizedTree.Node L x R _ =>
+      match (L, R) with
+        | (SizedTree.Empty, SizedTree.Empty) => SizedTree.Empty
+        | _ => sizedNode (sizedTrim L) x (sizedTrim R)
+
+theorem toTreeSizedTrim {α : Type} (t : SizedTree α) : toTree (sizedTrim t) = trim (toTree t) := by
+  induction t with
+  | Empty => rfl
+  | Node L x R n ihL ihR =>
+      cases L with
+      | Empty =>
+          cases R with
+          | Empty => rfl
+          | Node RL Rx RR Rn =>
+              calc
+                toTree (sizedTrim (SizedTree.Node SizedTree.Empty x (SizedTree.Node RL Rx RR Rn) n)) =
+                            Tree.Node (toTree (sizedTrim SizedTree.Empty)) x (toTree (sizedTrim (SizedTree.Node RL Rx RR Rn))) := by rfl
+                _         = Tree.Node (trim (toTree SizedTree.Empty)) x (trim (toTree (SizedTree.Node RL Rx RR Rn))) := by rw [ihL, ihR]
+                _         = trim (toTree (SizedTree.Node SizedTree.Empty x (SizedTree.Node RL Rx RR Rn) n)) := by rfl
+      | Node LL Lx LR Ln =>
+          calc
+            toTree (sizedTrim (SizedTree.Node (SizedTree.Node LL Lx LR Ln) x R n)) =
+                            Tree.Node (toTree (sizedTrim (SizedTree.Node LL Lx LR Ln))) x (toTree (sizedTrim R)) := by rfl
+            _             = Tree.Node (trim (toTree (SizedTree.Node LL Lx LR Ln))) x (trim (toTree R)) := by rw [ihL, ihR]
+            _             = trim (toTree (SizedTree.Node (SizedTree.Node LL Lx LR Ln) x R n)) := by rfl
+
+theorem sizedTrimValid {α : Type} (t : SizedTree α) : sizedValid t → sizedValid (sizedTrim t) := by
+  induction t with
+  | Empty => intro _; trivial
+  | Node L x R n ihL ihR =>
+      cases L with
+      | Empty =>
+          cases R with
+          | Empty => intro _; trivial
+          | Node RL Rx RR Rn =>
+              intro h
+              have h' := sizedValidNode h
+              exact sizedNodeValid (sizedTrim SizedTree.Empty) x (sizedTrim (SizedTree.Node RL Rx RR Rn)) (ihL h'.2.1) (ihR h'.2.2)
+      | Node LL Lx LR Ln =>
+          intro h
+          have h' := sizedValidNode h
+          exact sizedNodeValid (sizedTrim (SizedTree.Node LL Lx LR Ln)) x (sizedTrim R) (ihL h'.2.1) (ihR h'.2.2)
+
+theorem sizedTrimSize {α : Type} (t : SizedTree α) (h : sizedValid t) :
+  sizedSize (sizedTrim t) + len (leaves (toTree t)) = sizedSize t := by
+  rw [sizedSizeEquiv (sizedTrim t) (sizedTrimValid t h), sizedSizeEquiv t h, toTreeSizedTrim, trimSize]
+
+-- A SizedTree built through the raw constructor can cache any Nat it likes,
+-- so everything above has to carry a sizedValid hypothesis. ValidSizedTree
+-- packs the proof in with the tree, and the operations below keep it there,
+-- so the cached size is always right and the theorems need no hypothesis.
+
+abbrev ValidSizedTree (α : Type) := {t : SizedTree α // sizedValid t}
+
+def validEmpty {α : Type} : ValidSizedTree α :=
+  ⟨SizedTree.Empty, trivial⟩
+
+def validNode {α : Type} (L : ValidSizedTree α) (x : α) (R : ValidSizedTree α) : ValidSizedTree α :=
+  ⟨sizedNode L.1 x R.1, sizedNodeValid L.1 x R.1 L.2 R.2⟩
+
+def validLeaf {α : Type} (x : α) : ValidSizedTree α :=
+  validNode validEmpty x validEmpty
+
+def validOfTree {α : Type} (T : Tree α) : ValidSizedTree α :=
+  ⟨ofTree T, ofTreeValid T⟩
+
+def validMap {α β : Type} (f : α → β) (t : ValidSizedTree α) : ValidSizedTree β :=
+  ⟨sizedMap f t.1, sizedMapValid f t.1 t.2⟩
+
+def validTrim {α : Type} (t : ValidSizedTree α) : ValidSizedTree α :=
+  ⟨sizedTrim t.1, sizedTrimValid t.1 t.2⟩
+
+def validSize {α : Type} (t : ValidSizedTree α) : Nat :=
+  sizedSize t.1
+
+def validToTree {α : Type} (t : ValidSizedTree α) : Tree α :=
+  toTree t.1
+
+theorem validSizeEquiv {α : Type} (t : ValidSizedTree α) : validSize t = size (validToTree t) :=
+  sizedSizeEquiv t.1 t.2
+
+theorem validToTreeOfTree {α : Type} (T : Tree α) : validToTree (validOfTree T) = T :=
+  toTreeOfTree T
+
+theorem validToTreeMap {α β : Type} (f : α → β) (t : ValidSizedTree α) :
+  validToTree (validMap f t) = treeMap f (validToTree t) :=
+  toTreeSizedMap f t.1
+
+theorem validToTreeTrim {α : Type} (t : ValidSizedTree α) : validToTree (validTrim t) = trim (validToTree t) :=
+  toTreeSizedTrim t.1
+
+theorem validTrimSize {α : Type} (t : ValidSizedTree α) :
+  validSize (validTrim t) + len (leaves (validToTree t)) = validSize t :=
+  sizedTrimSize t.1 t.2
+
+end structural_datatypes
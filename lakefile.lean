@@ -10,3 +10,18 @@ require mathlib from git
 @[default_target]
 lean_lib «Project» where
   -- add any library configuration options here
+
+lean_lib «Bench» where
+  roots := #[`Bench.util]
+
+lean_exe «parbench» where
+  root := `Bench.par
+
+lean_exe «fusionbench» where
+  root := `Bench.fusion
+
+lean_exe «bench» where
+  root := `Bench.bench
+
+lean_exe «serialbench» where
+  root := `Bench.serial